@@ -2,6 +2,10 @@
 #include <ncurses.h>
 #include <time.h>
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <ctype.h>
 
 // Defining struct which is used to store the coordinates of the danger location
 typedef struct
@@ -10,10 +14,47 @@ typedef struct
     int y;
 } danger_coordinates;
 
+// A curve parameter takes the value start + step * level at each level
+typedef struct
+{
+    int start;
+    int step;
+} curve_parameter;
+
+// Level curve as written in the config file, before it is compiled into a table
+typedef struct
+{
+    int level_count;
+    curve_parameter tick;
+    curve_parameter rescues;
+    curve_parameter obstacles;
+    curve_parameter big_mac_odds;
+    curve_parameter crazy_odds;
+} level_curve;
+
+// One entry of the compiled level table, read directly by the game loop
+typedef struct
+{
+    int tick;         // Delay between two moves of the robot in ms
+    int rescues;      // Rescues needed to reach the next level
+    int obstacles;    // Obstacles spawned per rescue
+    int big_mac_odds; // Chance in percent of a Big Mac spawning on level up
+    int crazy_odds;   // Chance in percent of a CRAZY character spawning per rescue
+} level_settings;
+
 // Define the proportions of the window's dimentions with respect to the dimensions of the terminal
 #define ter2wincols 3 / 4
 #define ter2winrows 4 / 5
 
+// Level curve config file, the built-in curve is used when it does not exist
+#define level_config_file "levels.cfg"
+// Maximum number of levels a curve can describe, the last level repeats after that
+#define max_levels 64
+// Largest start or step of a curve parameter, keeps start + step * level well inside an int
+#define max_curve_value 100000
+// Cells that have to stay free for the robot (head and body), the person, the Big Mac and the CRAZY character
+#define reserved_cells 5
+
 // Basically mvadd but the colour is specified
 void display_coloured_character(int x, int y, char ch, int colour_code);
 
@@ -47,6 +88,23 @@ void pausing(int *ch, int speed_delay, int *quit);
 // Display ending information
 void outro (int centrexy[2], int Rpos[2], int Rrange[2], int level);
 
+// Read the level curve from the config file on top of the built-in curve, return 0 on success and write the reason to message otherwise
+// from_file is set to 1 when the config file exists and 0 when only the built-in curve is used
+int load_level_curve(const char *path, level_curve *curve, int *from_file, char message[80]);
+
+// Read one number of a config line, return 1 and store it in value when it is a whole number within max_curve_value
+int read_curve_value(const char *text, int *value, int *consumed);
+
+// Evaluate every curve parameter at every level and store the results in the level table
+void compile_level_table(level_curve *curve, level_settings level_table[max_levels]);
+
+// Number of cells inside the boundary that obstacles can take
+int board_free_cells(int Rrange[4]);
+
+// Reject level tables with a tick period that is not positive, odds outside 0-100 or more obstacles than the board can hold by the end of the last level
+// Past the last level the game itself stops spawning obstacles once the board is full
+int validate_level_table(level_settings level_table[max_levels], int level_count, int Rrange[4], char message[80]);
+
 
 int main()
 {
@@ -86,6 +144,33 @@ int main()
     // Drawing game boundary
     draw_boundary(tercols, terrows, Rrange, centrexy);
 
+    // Load the level curve and compile it into a table so the game loop only has to look up the current level
+    level_curve curve;
+    level_settings level_table[max_levels];
+    char message[80];
+    int from_file;
+    if (load_level_curve(level_config_file, &curve, &from_file, message) != 0)
+    {
+        endwin();
+        printf("%s: %s\n", level_config_file, message);
+        return 1;
+    }
+    compile_level_table(&curve, level_table);
+    if (from_file == 1 && validate_level_table(level_table, curve.level_count, Rrange, message) != 0)
+    {
+        endwin();
+        printf("%s: %s\n", level_config_file, message);
+        return 1;
+    }
+    // On a small terminal the built-in curve is shortened to the levels that fit, the obstacle cap below handles the rest
+    while (from_file == 0 && curve.level_count > 1 && validate_level_table(level_table, curve.level_count, Rrange, message) != 0)
+    {
+        curve.level_count--;
+    }
+    // Obstacles stop spawning once they would fill every free cell of the board
+    int free_cells = board_free_cells(Rrange);
+    level_settings *current_level = &level_table[0];
+
     // Introduction
     // Press any key to start the game
     intro (centrexy, Rpos);
@@ -97,13 +182,12 @@ int main()
     // initialise variables needed for processing the game
     int lives = 3;
     int level = 0;
-    int fifth_of_level = 0;
+    int rescues_in_level = 0;
     int score = 0;
     int ch;
-    int speed_delay = 80;
+    int speed_delay = current_level->tick;
     int *livesptr = &lives;
     int *levelptr = &level;
-    int *fifth_of_levelptr = &fifth_of_level;
     int *scoreptr = &score;
     int *chptr = &ch;
     int *speed_delayptr = &speed_delay;
@@ -130,8 +214,7 @@ int main()
     int generated_pos_BM[2] = {0, 0};
     // Track the position of the danger location using the danger_coordinates struct
     danger_coordinates *danger_coordinates_ptr = NULL;
-    int danger_coordinates_size = 2;
-    danger_coordinates_ptr = (danger_coordinates *)malloc(danger_coordinates_size * sizeof(danger_coordinates));
+    int danger_coordinates_size = 0;
 
     // Display game information at the top and bottom of the window
     attron(COLOR_PAIR(1));
@@ -172,24 +255,65 @@ int main()
             // Displays rescue information at the top of the window
             attron(COLOR_PAIR(4));
             mvprintw(0, 1, "One Person Rescued! Score += 10!        ");
-            // Update the score and fifth_of_level
+            // Update the score and rescues_in_level
             score += 10;
-            fifth_of_level += 1;
+            rescues_in_level += 1;
             // Generate the position of the next person to be rescued
             random_position_generator(Rrange, tercols, terrows, &generated_pos_person[0], &generated_pos_person[1], Rpos, danger_coordinates_ptr, danger_coordinates_size, generated_pos_BM, crazy_pos);
             display_coloured_character(generated_pos_person[1], generated_pos_person[0], '$', 4);
-            // Increase the speed of the robot when fifth_of_level is a multiple of 5 and produce a Big Mac if there isn't currently one
-            if (fifth_of_level == 5)
+            // Count the obstacles still on the board, hit obstacles are reset to (0, 0) and their slots are reused
+            int live_obstacles = 0;
+            for (int i = 0; i < danger_coordinates_size; i++)
+            {
+                if (danger_coordinates_ptr[i].x != 0 || danger_coordinates_ptr[i].y != 0)
+                {
+                    live_obstacles++;
+                }
+            }
+            // Generate the danger locations of the level this rescue belongs to without overfilling the board
+            int new_obstacles = current_level->obstacles;
+            if (new_obstacles > free_cells - live_obstacles)
+            {
+                new_obstacles = free_cells - live_obstacles;
+            }
+            // Only grow the danger_coordinates data when there are not enough free slots
+            if (new_obstacles > danger_coordinates_size - live_obstacles)
+            {
+                int new_size = live_obstacles + new_obstacles;
+                danger_coordinates_ptr = (danger_coordinates *)realloc(danger_coordinates_ptr, new_size * sizeof(danger_coordinates));
+                for (int i = danger_coordinates_size; i < new_size; i++)
+                {
+                    danger_coordinates_ptr[i].x = 0;
+                    danger_coordinates_ptr[i].y = 0;
+                }
+                danger_coordinates_size = new_size;
+            }
+            for (int i = 0; i < danger_coordinates_size && new_obstacles > 0; i++)
+            {
+                if (danger_coordinates_ptr[i].x == 0 && danger_coordinates_ptr[i].y == 0)
+                {
+                    random_position_generator(Rrange, tercols, terrows, &(danger_coordinates_ptr[i].x), &(danger_coordinates_ptr[i].y), Rpos, danger_coordinates_ptr, danger_coordinates_size, generated_pos_BM, crazy_pos);
+                    display_coloured_character(danger_coordinates_ptr[i].y, danger_coordinates_ptr[i].x, '#', 2);
+                    new_obstacles--;
+                    refresh();
+                }
+            }
+            // Level up when enough people are rescued and possibly produce a Big Mac if there isn't currently one
+            if (rescues_in_level >= current_level->rescues)
             {
                 // Displays level up information at the top of the window
                 attron(COLOR_PAIR(1));
                 mvprintw(0, 1, "Level Up!                               ");
-                // Reset fifth_of_leve and update level and speed_delay
-                fifth_of_level = 0;
+                // Reset rescues_in_level and update level, the level settings and speed_delay
+                rescues_in_level = 0;
                 level += 1;
-                speed_delay -= 5;
+                if (level < curve.level_count)
+                {
+                    current_level = &level_table[level];
+                }
+                speed_delay = current_level->tick;
                 // Generate a Big Mac if there is not currently a Big Mac
-                if (generated_pos_BM[0] == 0 && generated_pos_BM[1] == 0)
+                if (generated_pos_BM[0] == 0 && generated_pos_BM[1] == 0 && rand() % 100 < current_level->big_mac_odds)
                 {
                     random_position_generator(Rrange, tercols, terrows, &generated_pos_BM[0], &generated_pos_BM[1], Rpos, danger_coordinates_ptr, danger_coordinates_size, generated_pos_BM, crazy_pos);
                     display_coloured_character(generated_pos_BM[1], generated_pos_BM[0], 'M', 5);
@@ -198,18 +322,8 @@ int main()
             // Displays updated game information at the top of the window
             attron(COLOR_PAIR(1));
             mvprintw(Rrange[3] + 1, Rrange[0], "Score: %d     Level: %d      Lives: %d", score, level, lives);
-            // Genereate two danger locations
-            for (int i = 2; i > 0; i--)
-            {
-                random_position_generator(Rrange, tercols, terrows, &(danger_coordinates_ptr[danger_coordinates_size - i].x), &(danger_coordinates_ptr[danger_coordinates_size - i].y), Rpos, danger_coordinates_ptr, danger_coordinates_size, generated_pos_BM, crazy_pos);
-                display_coloured_character(danger_coordinates_ptr[danger_coordinates_size - i].y, danger_coordinates_ptr[danger_coordinates_size - i].x, '#', 2);
-                refresh();
-            }
-            // Update the danger_coordinates data
-            danger_coordinates_size += 2;
-            danger_coordinates_ptr = (danger_coordinates *)realloc(danger_coordinates_ptr, (danger_coordinates_size) * sizeof(danger_coordinates));
-            // Generate a CRAZY character if there are current no crazy character and crazy mode is not on
-            if (crazy_pos[0] == 0 && crazy_pos[1] == 0 && crazy_mode == 0)
+            // Possibly generate a CRAZY character if there are current no crazy character and crazy mode is not on
+            if (crazy_pos[0] == 0 && crazy_pos[1] == 0 && crazy_mode == 0 && rand() % 100 < current_level->crazy_odds)
             {
                 random_position_generator(Rrange, tercols, terrows, &crazy_pos[0], &crazy_pos[1], Rpos, danger_coordinates_ptr, danger_coordinates_size, generated_pos_BM, crazy_pos);
                 display_coloured_character(crazy_pos[1], crazy_pos[0], crazy[crazy_word_num], 3);
@@ -663,4 +777,198 @@ void outro (int centrexy[2], int Rpos[2], int Rrange[2], int level){
     }
     timeout(-1);
     mvprintw(centrexy[1]+2, centrexy[0] - 16, "Press any key to leave the game"); 
-}
\ No newline at end of file
+}
+
+// load_level_curve starts from the built-in curve and overrides every parameter found in the config file
+// A missing config file is not an error, a malformed line is
+int load_level_curve(const char *path, level_curve *curve, int *from_file, char message[80])
+{
+    // Built-in curve: five rescues per level, two obstacles per rescue, a Big Mac on every level up and a CRAZY character on every rescue
+    // The robot speeds up by 5ms per level until it reaches 5ms at level 15
+    curve->level_count = 16;
+    curve->tick = (curve_parameter){80, -5};
+    curve->rescues = (curve_parameter){5, 0};
+    curve->obstacles = (curve_parameter){2, 0};
+    curve->big_mac_odds = (curve_parameter){100, 0};
+    curve->crazy_odds = (curve_parameter){100, 0};
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        *from_file = 0;
+        return 0; // No config file, keep the built-in curve
+    }
+    *from_file = 1;
+
+    // Every line is a key followed by a start value and an optional step per level, e.g. "tick 80 -5"
+    char line[128];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        line_number++;
+        char key[32];
+        char extra;
+        int consumed = 0;
+        // Skip empty lines and comments
+        if (sscanf(line, "%31s%n", key, &consumed) != 1 || key[0] == '#')
+        {
+            continue;
+        }
+        char *rest = line + consumed;
+        int start;
+        int step = 0;
+        int has_step = 0;
+        if (sscanf(rest, " %c", &extra) != 1)
+        {
+            snprintf(message, 80, "line %d: missing value for %s", line_number, key);
+            fclose(file);
+            return 1;
+        }
+        if (read_curve_value(rest, &start, &consumed) == 0)
+        {
+            snprintf(message, 80, "line %d: bad value, expected a number from -%d to %d", line_number, max_curve_value, max_curve_value);
+            fclose(file);
+            return 1;
+        }
+        rest += consumed;
+        // The step is optional, but anything written after the start value has to be a valid step
+        if (sscanf(rest, " %c", &extra) == 1)
+        {
+            if (read_curve_value(rest, &step, &consumed) == 0)
+            {
+                snprintf(message, 80, "line %d: bad step, expected a number from -%d to %d", line_number, max_curve_value, max_curve_value);
+                fclose(file);
+                return 1;
+            }
+            has_step = 1;
+            rest += consumed;
+            if (sscanf(rest, " %c", &extra) == 1)
+            {
+                snprintf(message, 80, "line %d: unexpected text after the step", line_number);
+                fclose(file);
+                return 1;
+            }
+        }
+
+        curve_parameter *parameter = NULL;
+        if (strcmp(key, "levels") == 0)
+        {
+            if (has_step == 1)
+            {
+                snprintf(message, 80, "line %d: levels does not take a step", line_number);
+                fclose(file);
+                return 1;
+            }
+            if (start < 1 || start > max_levels)
+            {
+                snprintf(message, 80, "line %d: levels must be between 1 and %d", line_number, max_levels);
+                fclose(file);
+                return 1;
+            }
+            curve->level_count = start;
+            continue;
+        }
+        else if (strcmp(key, "tick") == 0)
+        {
+            parameter = &curve->tick;
+        }
+        else if (strcmp(key, "rescues") == 0)
+        {
+            parameter = &curve->rescues;
+        }
+        else if (strcmp(key, "obstacles") == 0)
+        {
+            parameter = &curve->obstacles;
+        }
+        else if (strcmp(key, "big_mac") == 0)
+        {
+            parameter = &curve->big_mac_odds;
+        }
+        else if (strcmp(key, "crazy") == 0)
+        {
+            parameter = &curve->crazy_odds;
+        }
+        else
+        {
+            snprintf(message, 80, "line %d: unknown key %s", line_number, key);
+            fclose(file);
+            return 1;
+        }
+        parameter->start = start;
+        parameter->step = step;
+    }
+    fclose(file);
+    return 0;
+}
+
+// read_curve_value only accepts a number that ends at whitespace, so "5x" or "- 5" are rejected instead of being partly read
+int read_curve_value(const char *text, int *value, int *consumed)
+{
+    char *end;
+    errno = 0;
+    long number = strtol(text, &end, 10);
+    if (end == text || errno == ERANGE || number < -max_curve_value || number > max_curve_value)
+    {
+        return 0;
+    }
+    if (*end != '\0' && !isspace((unsigned char)*end))
+    {
+        return 0;
+    }
+    *value = (int)number;
+    *consumed = end - text;
+    return 1;
+}
+
+// compile_level_table evaluates the curve once per level, start and step are bounded by max_curve_value so this cannot overflow
+void compile_level_table(level_curve *curve, level_settings level_table[max_levels])
+{
+    for (int i = 0; i < curve->level_count; i++)
+    {
+        level_table[i].tick = curve->tick.start + curve->tick.step * i;
+        level_table[i].rescues = curve->rescues.start + curve->rescues.step * i;
+        level_table[i].obstacles = curve->obstacles.start + curve->obstacles.step * i;
+        level_table[i].big_mac_odds = curve->big_mac_odds.start + curve->big_mac_odds.step * i;
+        level_table[i].crazy_odds = curve->crazy_odds.start + curve->crazy_odds.step * i;
+    }
+}
+
+// board_free_cells takes the inside of the boundary minus the cells the robot and the pickups need
+int board_free_cells(int Rrange[4])
+{
+    return (Rrange[1] - Rrange[0] - 1) * (Rrange[3] - Rrange[2] - 1) - reserved_cells;
+}
+
+// validate_level_table walks the compiled table and writes the first problem it finds to message
+int validate_level_table(level_settings level_table[max_levels], int level_count, int Rrange[4], char message[80])
+{
+    int free_cells = board_free_cells(Rrange);
+    long long total_obstacles = 0;
+    for (int i = 0; i < level_count; i++)
+    {
+        if (level_table[i].tick <= 0)
+        {
+            snprintf(message, 80, "level %d: tick period %d is not positive", i, level_table[i].tick);
+            return 1;
+        }
+        if (level_table[i].rescues < 1 || level_table[i].obstacles < 0)
+        {
+            snprintf(message, 80, "level %d: needs at least one rescue and no negative obstacles", i);
+            return 1;
+        }
+        if (level_table[i].big_mac_odds < 0 || level_table[i].big_mac_odds > 100 || level_table[i].crazy_odds < 0 || level_table[i].crazy_odds > 100)
+        {
+            snprintf(message, 80, "level %d: odds must be between 0 and 100", i);
+            return 1;
+        }
+        // Obstacles are never removed from the board unless they are hit, so count every obstacle up to this level
+        // Every rescue of a level, including the one that levels up, spawns that level's obstacles
+        total_obstacles += (long long)level_table[i].rescues * level_table[i].obstacles;
+        if (total_obstacles > free_cells)
+        {
+            snprintf(message, 80, "level %d: %lld obstacles overfill the %d free cells", i, total_obstacles, free_cells);
+            return 1;
+        }
+    }
+    return 0;
+}